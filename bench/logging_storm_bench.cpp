@@ -0,0 +1,111 @@
+// Tormenta de métricas anómalas: todas disparan el log de anomalía y el de
+// AlertManager. Compara logger síncrono y asíncrono, con y sin
+// LOG_RATE_LIMITED efectivo, escribiendo a un fichero.
+#include "AlertManager.h"
+#include "Config.h"
+#include "Logging.h"
+#include "MetricsProcessor.h"
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+Config g_config;
+
+namespace {
+
+constexpr int kThreads = 4;
+constexpr int kMetricsPerThread = 50'000;
+
+std::shared_ptr<spdlog::logger> make_logger(const std::string& path, bool async) {
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path, true);
+    if (async) {
+        spdlog::init_thread_pool(static_cast<size_t>(g_config.log_queue_size), 1);
+        return std::make_shared<spdlog::async_logger>("bench", sink,
+            spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    }
+    return std::make_shared<spdlog::logger>("bench", sink);
+}
+
+// Los limitadores son estáticos por call site: cada configuración empieza
+// en un segundo nuevo para no heredar el cupo gastado por la anterior
+void wait_for_next_window() {
+    auto second = [] {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    auto current = second();
+    while (second() == current) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void run(const std::string& path, bool async, bool rate_limited) {
+    wait_for_next_window();
+
+    g_config.log_async = async;
+    g_config.log_rate_limit_per_second = rate_limited ? 10 : INT_MAX;
+
+    spdlog::set_default_logger(make_logger(path, async));
+    spdlog::set_level(spdlog::level::info);
+
+    auto processor = std::make_shared<MetricsProcessor>();
+    AlertManager alert_manager(processor);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&processor, t] {
+            Metric metric;
+            metric.endpoint = "/api/v1/orders/" + std::to_string(t);
+            metric.method = "POST";
+            metric.status = "200";
+            metric.status_class = classify_status(metric.status);
+            for (int i = 0; i < kMetricsPerThread; ++i) {
+                metric.duration_ms = static_cast<uint64_t>(g_config.alert_threshold_ms) + 1 + i % 1000;
+                processor->process_metric(metric);
+            }
+            });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto dropped = dropped_log_messages();
+    spdlog::shutdown();
+
+    size_t lines_written = 0;
+    std::ifstream log_file(path);
+    for (std::string line; std::getline(log_file, line);) {
+        ++lines_written;
+    }
+
+    double ns_per_metric = std::chrono::duration<double, std::nano>(elapsed).count() /
+        (static_cast<double>(kThreads) * kMetricsPerThread);
+    std::printf("%-6s %-13s %10.1f ns/metric  lines=%-8zu dropped=%zu\n",
+        async ? "async" : "sync", rate_limited ? "rate-limited" : "unlimited",
+        ns_per_metric, lines_written, dropped);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "logging_storm_bench.log";
+
+    std::printf("%d threads x %d anomalous metrics, 2 warn lines each, file sink %s\n",
+        kThreads, kMetricsPerThread, path.c_str());
+
+    run(path, false, false);
+    run(path, true, false);
+    run(path, false, true);
+    run(path, true, true);
+    return 0;
+}
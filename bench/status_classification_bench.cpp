@@ -0,0 +1,99 @@
+// Compara la ruta de agregación anterior (comparación de strings del status
+// en cada métrica) con classify_status + aggregate_metric<Schema>.
+#include "MetricSchema.h"
+#include "MetricsProcessor.h"
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Mismas agregaciones que la ruta anterior: contadores y buffer de latencia
+struct LegacyEquivalentSchema {
+    static constexpr auto& fields = DefaultMetricSchema::fields;
+    static constexpr uint32_t aggregations = kAggregateCounts | kAggregateLatency;
+};
+
+constexpr int kIterations = 5'000'000;
+constexpr int kExemplarWindowSeconds = 60;
+
+std::vector<Metric> make_metrics() {
+    constexpr std::string_view statuses[] = { "200", "201", "success", "304", "404", "500", "200", "204" };
+    constexpr std::string_view trace_ids[] = { "4bf92f3577b34da6a3ce929d0e0e4736", "" };
+
+    std::vector<Metric> metrics;
+    for (size_t i = 0; i < 64; ++i) {
+        Metric metric;
+        metric.endpoint = "/api/v1/orders";
+        metric.method = "POST";
+        metric.duration_ms = 20 + (i * 37) % 900;
+        metric.status = statuses[i % std::size(statuses)];
+        metric.trace_id = trace_ids[i % std::size(trace_ids)];
+        metrics.push_back(std::move(metric));
+    }
+    return metrics;
+}
+
+void legacy_aggregate(EndpointStats& stats, const Metric& metric, std::atomic<uint64_t>& total_errors) {
+    stats.request_count++;
+    stats.last_request = std::chrono::steady_clock::now();
+
+    if (metric.status == "success" || metric.status == "200") {
+        stats.success_count++;
+    }
+    else {
+        stats.error_count++;
+        total_errors++;
+    }
+
+    stats.latency_buffer->push(static_cast<double>(metric.duration_ms));
+}
+
+template <typename Aggregate>
+double run(const char* name, std::vector<Metric>& metrics, Aggregate&& aggregate) {
+    EndpointStats stats;
+    std::atomic<uint64_t> total_errors{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        aggregate(stats, metrics[i & 63], total_errors);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns_per_metric = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+    std::printf("%-44s %8.2f ns/metric  (errors=%llu)\n", name, ns_per_metric,
+        static_cast<unsigned long long>(total_errors.load()));
+    return ns_per_metric;
+}
+
+}
+
+int main() {
+    auto metrics = make_metrics();
+
+    run("legacy: status string compare", metrics,
+        [](EndpointStats& stats, Metric& metric, std::atomic<uint64_t>& total_errors) {
+            legacy_aggregate(stats, metric, total_errors);
+        });
+
+    // classify_status corre en el parser; se incluye aquí para que el coste
+    // total por métrica sea comparable
+    run("classify_status + LegacyEquivalentSchema", metrics,
+        [](EndpointStats& stats, Metric& metric, std::atomic<uint64_t>& total_errors) {
+            metric.status_class = classify_status(metric.status);
+            if (aggregate_metric<LegacyEquivalentSchema>(stats, metric, 1, kExemplarWindowSeconds)) {
+                total_errors++;
+            }
+        });
+
+    run("classify_status + DefaultMetricSchema", metrics,
+        [](EndpointStats& stats, Metric& metric, std::atomic<uint64_t>& total_errors) {
+            metric.status_class = classify_status(metric.status);
+            if (aggregate_metric<DefaultMetricSchema>(stats, metric, 1, kExemplarWindowSeconds)) {
+                total_errors++;
+            }
+        });
+
+    return 0;
+}
@@ -1,21 +1,51 @@
 #include <iostream>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <thread>
 #include <signal.h>
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <algorithm>
 
 #include "Config.h"
 #include "MetricsProcessor.h"
 #include "HttpServer.h"
 #include "AlertManager.h"
+#include "Logging.h"
 
 Config g_config;
 std::unique_ptr<HttpServer> g_server;
 
+// El handler de señales solo marca estas variables; el apagado (parar los
+// servidores y vaciar la cola de logs) se hace desde main
+std::atomic<bool> g_shutdown_requested{ false };
+std::atomic<int> g_shutdown_signal{ 0 };
+
 void setup_logging() {
-    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    auto logger = std::make_shared<spdlog::logger>("metrics_service", console_sink);
+    spdlog::sink_ptr sink;
+    if (g_config.log_format == "json") {
+        sink = std::make_shared<spdlog::sinks::stdout_sink_mt>();
+        sink->set_formatter(std::make_unique<JsonLogFormatter>());
+    }
+    else {
+        sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        sink->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%^%l%$] [%t] %v");
+    }
+
+    // En modo asíncrono los hilos de ingesta solo encolan; un hilo de fondo
+    // escribe en stdout y, si la cola se llena, se descarta lo más antiguo
+    std::shared_ptr<spdlog::logger> logger;
+    if (g_config.log_async) {
+        spdlog::init_thread_pool(static_cast<size_t>(std::max(1, g_config.log_queue_size)), 1);
+        logger = std::make_shared<spdlog::async_logger>("metrics_service", sink,
+            spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    }
+    else {
+        logger = std::make_shared<spdlog::logger>("metrics_service", sink);
+    }
 
     if (g_config.log_level == "debug") {
         logger->set_level(spdlog::level::debug);
@@ -27,18 +57,14 @@ void setup_logging() {
         logger->set_level(spdlog::level::info);
     }
 
-    logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%^%l%$] [%t] %v");
-
     spdlog::set_default_logger(logger);
-    spdlog::info("Logging system initialized (level: {})", g_config.log_level);
+    spdlog::info("Logging system initialized (level: {}, format: {}, async: {})",
+        g_config.log_level, g_config.log_format, g_config.log_async);
 }
 
 void signal_handler(int signal) {
-    spdlog::info("Received signal {}, shutting down gracefully...", signal);
-    if (g_server) {
-        g_server->stop();
-    }
-    exit(0);
+    g_shutdown_signal = signal;
+    g_shutdown_requested = true;
 }
 
 void setup_signal_handlers() {
@@ -67,10 +93,26 @@ int main() {
         spdlog::info("BTECH Metrics Service ready!");
         spdlog::info("Service accessible at: http://localhost:{}", g_config.port);
         spdlog::info("Dashboard: http://localhost:3000");
-        spdlog::info("Health check: http://localhost:{}/health", g_config.port);
-
-        g_server->start(g_config.port);
-
+        spdlog::info("Health check: http://localhost:{}/health", g_config.control_port);
+
+        // start() abre los puertos y lanza los servidores en sus hilos; el hilo
+        // principal espera a una señal o a que un servidor termine solo
+        if (!g_server->start(g_config.port)) {
+            spdlog::critical("Could not open the HTTP ports, exiting");
+            spdlog::shutdown();
+            return 1;
+        }
+
+        while (!g_shutdown_requested && g_server->running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        if (int signal = g_shutdown_signal.load()) {
+            spdlog::info("Received signal {}, shutting down gracefully...", signal);
+        }
+        g_server->stop();
+        g_server.reset();
+        spdlog::shutdown();
     }
     catch (const std::exception& e) {
         spdlog::critical("Fatal error: {}", e.what());
@@ -1,5 +1,6 @@
 #include "AlertManager.h"
 #include "Config.h"
+#include "Logging.h"
 #include <spdlog/spdlog.h>
 
 AlertManager::AlertManager(std::shared_ptr<MetricsProcessor> processor)
@@ -20,8 +21,8 @@ void AlertManager::setup_default_alerts() {
 }
 
 void AlertManager::log_alert(const Metric& metric) {
-    spdlog::warn("ALERT: High latency detected - Endpoint: {} {}ms - Status: {}", 
-                 metric.endpoint, metric.duration_ms, metric.status);
+    LOG_RATE_LIMITED(spdlog::level::warn, "ALERT: High latency detected - Endpoint: {} {}ms - Status: {}",
+                     metric.endpoint, metric.duration_ms, metric.status);
 }
 
 void AlertManager::send_slack_alert(const Metric& metric) {
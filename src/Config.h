@@ -4,21 +4,60 @@
 
 struct Config {
     int port;
+    int control_port;
     std::string redis_host;
     int redis_port;
     int max_metrics_buffer;
     bool enable_alerts;
     std::string log_level;
+    std::string log_format;
+    bool log_async;
+    int log_queue_size;
+    int log_rate_limit_per_second;
     int alert_threshold_ms;
+    int exemplar_window_seconds;
+    int worker_threads;
+    int control_threads;
+    int ingest_keep_alive_max_count;
+    int ingest_keep_alive_timeout_seconds;
+    int max_queued_requests;
+    int ingest_shed_queue_depth;
+    double ingest_sampling_watermark;
+    int ingest_sample_rate;
+    int retry_after_seconds;
 
     Config() {
         port = std::getenv("PORT") ? std::atoi(std::getenv("PORT")) : 8080;
+        control_port = std::getenv("CONTROL_PORT") ? std::atoi(std::getenv("CONTROL_PORT")) : port + 1;
         redis_host = std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost";
         redis_port = std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379;
         max_metrics_buffer = 10000;
         enable_alerts = true;
         log_level = std::getenv("LOG_LEVEL") ? std::getenv("LOG_LEVEL") : "info";
+        log_format = std::getenv("LOG_FORMAT") ? std::getenv("LOG_FORMAT") : "text";
+        log_async = std::getenv("LOG_ASYNC") ? std::string(std::getenv("LOG_ASYNC")) != "false" : true;
+        log_queue_size = std::getenv("LOG_QUEUE_SIZE") ? std::atoi(std::getenv("LOG_QUEUE_SIZE")) : 8192;
+        log_rate_limit_per_second = std::getenv("LOG_RATE_LIMIT") ? std::atoi(std::getenv("LOG_RATE_LIMIT")) : 10;
         alert_threshold_ms = 5000;
+        exemplar_window_seconds = std::getenv("EXEMPLAR_WINDOW_SECONDS") ? std::atoi(std::getenv("EXEMPLAR_WINDOW_SECONDS")) : 60;
+
+        // Control de admisión: la ingesta (PORT) y health/consultas (CONTROL_PORT)
+        // corren en servidores con pools separados, así la ingesta nunca bloquea
+        // a CONTROL_PORT/health. PORT/health se mantiene para las sondas
+        // existentes pero comparte el pool de ingesta. El keep-alive de ingesta
+        // se acota para no fijar workers.
+        worker_threads = std::getenv("WORKER_THREADS") ? std::atoi(std::getenv("WORKER_THREADS")) : 8;
+        control_threads = std::getenv("CONTROL_THREADS") ? std::atoi(std::getenv("CONTROL_THREADS")) : 2;
+        ingest_keep_alive_max_count = std::getenv("INGEST_KEEP_ALIVE_MAX") ? std::atoi(std::getenv("INGEST_KEEP_ALIVE_MAX")) : 5;
+        ingest_keep_alive_timeout_seconds = 1;
+        // Con la cola llena httplib cierra el socket sin respuesta; por encima de
+        // este límite blando se responde 503 + Retry-After y el worker se libera
+        // enseguida, así que es lo que ven los clientes antes de llegar al tope
+        max_queued_requests = std::getenv("MAX_QUEUED_REQUESTS") ? std::atoi(std::getenv("MAX_QUEUED_REQUESTS")) : 256;
+        ingest_shed_queue_depth = std::getenv("INGEST_SHED_QUEUE_DEPTH") ? std::atoi(std::getenv("INGEST_SHED_QUEUE_DEPTH")) : max_queued_requests / 4;
+        ingest_sampling_watermark = std::getenv("INGEST_SAMPLING_WATERMARK") ? std::atof(std::getenv("INGEST_SAMPLING_WATERMARK")) : 0.75;
+        ingest_sample_rate = std::getenv("INGEST_SAMPLE_RATE") ? std::atoi(std::getenv("INGEST_SAMPLE_RATE")) : 1;
+        retry_after_seconds = 1;
     }
 };
 
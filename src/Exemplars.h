@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Un trace_id W3C son 32 caracteres hex
+constexpr size_t kExemplarTraceIdCapacity = 32;
+
+// Solo se guardan trace_ids hex que caben enteros: uno truncado no enlaza
+// con ninguna traza, y cortar bytes arbitrarios puede partir una secuencia
+// UTF-8 que luego rompe el JSON y las labels de Prometheus
+constexpr bool is_exemplar_trace_id(std::string_view trace_id) {
+    if (trace_id.empty() || trace_id.size() > kExemplarTraceIdCapacity) {
+        return false;
+    }
+    for (char c : trace_id) {
+        bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        if (!hex) return false;
+    }
+    return true;
+}
+
+static_assert(is_exemplar_trace_id("4bf92f3577b34da6a3ce929d0e0e4736"));
+static_assert(!is_exemplar_trace_id("4bf92f3577b34da6a3ce929d0e0e47360"));
+static_assert(!is_exemplar_trace_id("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\xc3\xa9"));
+
+struct Exemplar {
+    std::array<char, kExemplarTraceIdCapacity> trace_id{};
+    uint8_t trace_id_length = 0;
+    uint64_t value_ms = 0;
+    int64_t timestamp_ms = 0;
+    int64_t window = 0;
+
+    std::string_view trace() const {
+        return std::string_view(trace_id.data(), trace_id_length);
+    }
+};
+
+// Slot de exemplar sin locks ni heap, protegido por un seqlock. El escritor
+// reclama el slot con un CAS par -> impar; si otro hilo lo tiene, se descarta
+// la muestra (los exemplars son best-effort).
+class ExemplarSlot {
+private:
+    static constexpr size_t kWords = kExemplarTraceIdCapacity / sizeof(uint64_t);
+
+    std::atomic<uint32_t> sequence{ 0 };
+    std::array<std::atomic<uint64_t>, kWords> trace_words{};
+    std::atomic<uint8_t> trace_length{ 0 };
+    std::atomic<uint64_t> value{ 0 };
+    std::atomic<int64_t> timestamp{ 0 };
+    std::atomic<int64_t> window_id{ 0 };
+
+public:
+    bool try_store(std::string_view trace_id, uint64_t value_ms, int64_t timestamp_ms, int64_t window) {
+        if (!is_exemplar_trace_id(trace_id)) {
+            return false;
+        }
+
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        if ((seq & 1) || !sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t length = trace_id.size();
+        for (size_t i = 0; i < kWords; ++i) {
+            uint64_t word = 0;
+            size_t offset = i * sizeof(uint64_t);
+            if (offset < length) {
+                std::memcpy(&word, trace_id.data() + offset, std::min(sizeof(uint64_t), length - offset));
+            }
+            trace_words[i].store(word, std::memory_order_relaxed);
+        }
+        trace_length.store(static_cast<uint8_t>(length), std::memory_order_relaxed);
+        value.store(value_ms, std::memory_order_relaxed);
+        timestamp.store(timestamp_ms, std::memory_order_relaxed);
+        window_id.store(window, std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+        return true;
+    }
+
+    bool load(Exemplar& out) const {
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before == 0) {
+                return false;
+            }
+            if (before & 1) {
+                continue;
+            }
+
+            for (size_t i = 0; i < kWords; ++i) {
+                uint64_t word = trace_words[i].load(std::memory_order_relaxed);
+                std::memcpy(out.trace_id.data() + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+            }
+            out.trace_id_length = trace_length.load(std::memory_order_relaxed);
+            out.value_ms = value.load(std::memory_order_relaxed);
+            out.timestamp_ms = timestamp.load(std::memory_order_relaxed);
+            out.window = window_id.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Lecturas sueltas para el filtro rápido; pueden estar desfasadas
+    uint64_t peek_value() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    int64_t peek_window() const {
+        return window_id.load(std::memory_order_relaxed);
+    }
+};
+
+// Ventana de tiempo fija a la que pertenece un timestamp
+constexpr int64_t exemplar_window(int64_t timestamp_ms, int window_seconds) {
+    return timestamp_ms / (1000 * std::max(1, window_seconds));
+}
+
+constexpr int64_t exemplar_window_start_ms(int64_t window, int window_seconds) {
+    return window * 1000 * std::max(1, window_seconds);
+}
+
+// Los K trace_ids más lentos de la ventana de tiempo actual
+template <size_t K>
+class SlowestExemplars {
+private:
+    std::array<ExemplarSlot, K> slots;
+
+public:
+    void offer(std::string_view trace_id, uint64_t value_ms, int64_t timestamp_ms, int64_t window) {
+        size_t victim = K;
+        uint64_t victim_value = UINT64_MAX;
+
+        for (size_t i = 0; i < K; ++i) {
+            uint64_t slot_value = slots[i].peek_window() == window ? slots[i].peek_value() : 0;
+            if (slot_value < victim_value) {
+                victim = i;
+                victim_value = slot_value;
+            }
+        }
+
+        if (victim < K && (victim_value == 0 || value_ms > victim_value)) {
+            slots[victim].try_store(trace_id, value_ms, timestamp_ms, window);
+        }
+    }
+
+    // Copia los exemplars de la ventana indicada (normalmente la actual), de
+    // más lento a más rápido; las ventanas ya cerradas no se reportan
+    size_t snapshot(int64_t window, std::array<Exemplar, K>& out) const {
+        size_t count = 0;
+
+        for (const auto& slot : slots) {
+            Exemplar exemplar;
+            if (slot.load(exemplar) && exemplar.window == window) {
+                out[count++] = exemplar;
+            }
+        }
+
+        for (size_t i = 1; i < count; ++i) {
+            for (size_t j = i; j > 0 && out[j - 1].value_ms < out[j].value_ms; --j) {
+                std::swap(out[j - 1], out[j]);
+            }
+        }
+        return count;
+    }
+};
+
+constexpr std::array<uint64_t, 11> kLatencyBucketBoundsMs = {
+    5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000
+};
+
+// Histograma de latencia con buckets fijos (+Inf al final) y el último
+// exemplar observado en cada bucket
+class LatencyHistogram {
+public:
+    static constexpr size_t kBucketCount = kLatencyBucketBoundsMs.size() + 1;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+    std::atomic<uint64_t> sum_ms{ 0 };
+    std::array<ExemplarSlot, kBucketCount> exemplars;
+
+public:
+    static constexpr size_t bucket_for(uint64_t value_ms) {
+        size_t index = 0;
+        while (index < kLatencyBucketBoundsMs.size() && value_ms > kLatencyBucketBoundsMs[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+    void observe(uint64_t value_ms, uint64_t weight, std::string_view trace_id, int64_t timestamp_ms) {
+        size_t index = bucket_for(value_ms);
+        counts[index].fetch_add(weight, std::memory_order_relaxed);
+        sum_ms.fetch_add(value_ms * weight, std::memory_order_relaxed);
+
+        if (is_exemplar_trace_id(trace_id)) {
+            exemplars[index].try_store(trace_id, value_ms, timestamp_ms, 0);
+        }
+    }
+
+    uint64_t count(size_t bucket) const {
+        return counts[bucket].load(std::memory_order_relaxed);
+    }
+
+    uint64_t sum() const {
+        return sum_ms.load(std::memory_order_relaxed);
+    }
+
+    bool exemplar(size_t bucket, Exemplar& out) const {
+        return exemplars[bucket].load(out);
+    }
+};
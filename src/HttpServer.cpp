@@ -1,24 +1,107 @@
 #include "HttpServer.h"
 #include "Config.h"
+#include "Logging.h"
+#include "MetricParser.h"
+#include "RequestArena.h"
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string_view>
+
+namespace {
+
+// Respuestas constantes de la ruta de ingesta, serializadas una sola vez
+constexpr std::string_view kMetricProcessedResponse =
+    R"({"message":"Metric processed successfully","success":true})";
+constexpr std::string_view kMetricSampledResponse =
+    R"({"message":"Metric sampled","success":true})";
+constexpr std::string_view kOverloadedResponse =
+    R"({"error":"Service overloaded, retry later","success":false})";
+
+// ThreadPool acotado que cuenta las conexiones en cola y las que tienen un
+// worker fijado (httplib mantiene el worker durante todo el keep-alive)
+class TrackedThreadPool : public httplib::TaskQueue {
+private:
+    httplib::ThreadPool pool;
+    std::atomic<int>& queue_depth;
+    std::atomic<int>& pinned;
+
+public:
+    TrackedThreadPool(size_t threads, size_t max_queued, std::atomic<int>& depth, std::atomic<int>& active)
+        : pool(threads, max_queued), queue_depth(depth), pinned(active) {}
+
+    bool enqueue(std::function<void()> fn) override {
+        queue_depth++;
+        bool accepted = pool.enqueue([this, fn = std::move(fn)]() {
+            queue_depth--;
+            pinned++;
+            fn();
+            pinned--;
+            });
+
+        if (!accepted) {
+            queue_depth--;
+        }
+        return accepted;
+    }
+
+    void shutdown() override {
+        pool.shutdown();
+    }
+};
+
+struct InFlightGuard {
+    std::atomic<int>& counter;
+    ~InFlightGuard() { counter--; }
+};
+
+}
 
 HttpServer::HttpServer(std::shared_ptr<MetricsProcessor> processor)
     : metrics_processor(processor) {
     setup_routes();
 }
 
+HttpServer::~HttpServer() {
+    stop();
+}
+
 void HttpServer::setup_routes() {
-    setup_cors();
-    setup_health_routes();
-    setup_metrics_routes();
-    setup_admin_routes();
+    setup_task_queues();
+    setup_cors(server);
+    setup_cors(control_server);
+    setup_health_routes(control_server);
+    setup_ingest_routes();
+    setup_query_routes(control_server);
+    setup_exposition_routes();
+    setup_admin_routes(control_server);
+    setup_legacy_routes();
 
     spdlog::info("HTTP routes configured");
 }
 
-void HttpServer::setup_cors() {
-    server.set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+void HttpServer::setup_task_queues() {
+    server.new_task_queue = [this] {
+        return new TrackedThreadPool(
+            static_cast<size_t>(std::max(1, g_config.worker_threads)),
+            static_cast<size_t>(std::max(1, g_config.max_queued_requests)),
+            queued_connections,
+            pinned_connections);
+    };
+
+    // Un worker de ingesta no debe quedarse esperando al siguiente request
+    server.set_keep_alive_max_count(static_cast<size_t>(std::max(1, g_config.ingest_keep_alive_max_count)));
+    server.set_keep_alive_timeout(g_config.ingest_keep_alive_timeout_seconds);
+
+    control_server.new_task_queue = [] {
+        return new httplib::ThreadPool(static_cast<size_t>(std::max(1, g_config.control_threads)));
+    };
+}
+
+void HttpServer::setup_cors(httplib::Server& target) {
+    target.set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
         res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, X-Trace-ID");
@@ -31,13 +114,13 @@ void HttpServer::setup_cors() {
         });
 }
 
-void HttpServer::setup_health_routes() {
-    server.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+void HttpServer::setup_health_routes(httplib::Server& target) {
+    target.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
         auto health = metrics_processor->get_system_health();
         res.set_content(health.dump(), "application/json");
         });
 
-    server.Get("/health/detailed", [this](const httplib::Request&, httplib::Response& res) {
+    target.Get("/health/detailed", [this](const httplib::Request&, httplib::Response& res) {
         auto health = metrics_processor->get_system_health();
         auto metrics = metrics_processor->get_realtime_metrics();
 
@@ -46,6 +129,15 @@ void HttpServer::setup_health_routes() {
             {"metrics_summary", {
                 {"total_endpoints", metrics["endpoints"].size()},
                 {"global_stats", metrics["global"]}
+            }},
+            {"ingest", {
+                {"in_flight", ingest_in_flight.load()},
+                {"pinned_connections", pinned_connections.load()},
+                {"queued_connections", queued_connections.load()}
+            }},
+            {"logging", {
+                {"async", g_config.log_async},
+                {"dropped_messages", dropped_log_messages()}
             }}
         };
 
@@ -53,34 +145,29 @@ void HttpServer::setup_health_routes() {
         });
 }
 
-void HttpServer::setup_metrics_routes() {
+void HttpServer::setup_ingest_routes() {
     server.Post("/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        ingest_in_flight++;
+        InFlightGuard in_flight_guard{ ingest_in_flight };
+
+        uint64_t weight = 1;
+        if (!admit_ingest(res, weight)) {
+            return;
+        }
+
         try {
-            auto json_data = nlohmann::json::parse(req.body);
-
-            Metric metric;
-            metric.endpoint = json_data["endpoint"];
-            metric.method = json_data["method"];
-            metric.duration_ms = json_data["duration"];
-            metric.status = json_data["status"];
-            metric.timestamp = json_data["timestamp"];
-            metric.trace_id = json_data.value("trace_id", "");
-            metric.service_name = json_data.value("service_name", "unknown");
-            metric.user_id = json_data.value("user_id", "");
-            metric.ip_address = json_data.value("ip_address", "");
-
-            metrics_processor->process_metric(metric);
-
-            nlohmann::json response = {
-                {"success", true},
-                {"message", "Metric processed successfully"}
-            };
+            RequestArenaScope arena;
+            Metric metric(arena.resource());
+            parse_metric(req.body, metric);
 
-            res.set_content(response.dump(), "application/json");
+            metrics_processor->process_metric(metric, weight);
 
+            // Parseo y procesamiento no tocan el heap; Request/Response son de
+            // httplib y el body constante se copia a su std::string
+            res.set_content(kMetricProcessedResponse.data(), kMetricProcessedResponse.size(), "application/json");
         }
         catch (const std::exception& e) {
-            spdlog::error("Error processing metric: {}", e.what());
+            LOG_RATE_LIMITED(spdlog::level::err, "Error processing metric: {}", e.what());
 
             nlohmann::json error_response = {
                 {"success", false},
@@ -91,50 +178,165 @@ void HttpServer::setup_metrics_routes() {
             res.set_content(error_response.dump(), "application/json");
         }
         });
+}
 
-    server.Get("/metrics/realtime", [this](const httplib::Request&, httplib::Response& res) {
+void HttpServer::setup_query_routes(httplib::Server& target) {
+    target.Get("/metrics/realtime", [this](const httplib::Request&, httplib::Response& res) {
         auto metrics = metrics_processor->get_realtime_metrics();
         res.set_content(metrics.dump(), "application/json");
         });
 
-    server.Get(R"(/metrics/endpoint/(.+))", [this](const httplib::Request& req, httplib::Response& res) {
+    target.Get(R"(/metrics/endpoint/(.+))", [this](const httplib::Request& req, httplib::Response& res) {
         std::string endpoint = req.matches[1];
         auto metrics = metrics_processor->get_endpoint_metrics(endpoint);
         res.set_content(metrics.dump(), "application/json");
         });
 }
 
-void HttpServer::setup_admin_routes() {
-    server.Get("/info", [](const httplib::Request&, httplib::Response& res) {
+void HttpServer::setup_exposition_routes() {
+    control_server.Get("/metrics/prometheus", [this](const httplib::Request&, httplib::Response& res) {
+        res.set_content(metrics_processor->get_prometheus_metrics(),
+            "application/openmetrics-text; version=1.0.0; charset=utf-8");
+        });
+}
+
+// Antes de separar los servidores todas las rutas vivían en PORT. /health
+// sigue ahí para las sondas de liveness existentes; el resto de rutas de
+// lectura se mantiene por compatibilidad, marcado como deprecated, y comparte
+// el pool de ingesta, así que los clientes deben migrar a CONTROL_PORT.
+void HttpServer::setup_legacy_routes() {
+    setup_health_routes(server);
+    setup_query_routes(server);
+    setup_admin_routes(server);
+
+    server.set_post_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        if (req.method != "GET" || req.path == "/health") {
+            return;
+        }
+        res.set_header("Deprecation", "true");
+        LOG_RATE_LIMITED(spdlog::level::warn, "Deprecated: GET {} on the ingest port, use CONTROL_PORT {}",
+            req.path, g_config.control_port);
+        });
+}
+
+bool HttpServer::admit_ingest(httplib::Response& res, uint64_t& weight) {
+    int workers = std::max(1, g_config.worker_threads);
+    int shed_queue_depth = std::max(1, std::min(g_config.ingest_shed_queue_depth, g_config.max_queued_requests));
+    int pinned = pinned_connections.load();
+    int queued = queued_connections.load();
+
+    // Cada handler ocupa uno de los workers, así que la presión real es la
+    // cola: por encima del límite blando se corta rápido para vaciarla antes
+    // de que httplib empiece a cerrar conexiones sin respuesta. También se
+    // corta si todos los workers están fijados por conexiones y hay cola.
+    bool backlogged = queued >= shed_queue_depth;
+    bool saturated = pinned >= workers && queued > 0;
+
+    if (backlogged || saturated) {
+        metrics_processor->record_shed();
+
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(g_config.retry_after_seconds));
+        res.set_content(kOverloadedResponse.data(), kOverloadedResponse.size(), "application/json");
+        return false;
+    }
+
+    if (g_config.ingest_sample_rate <= 1) {
+        return true;
+    }
+
+    double pressure = std::max(
+        static_cast<double>(pinned) / workers,
+        static_cast<double>(queued) / shed_queue_depth);
+
+    if (pressure < g_config.ingest_sampling_watermark) {
+        return true;
+    }
+
+    // Muestreo 1 de cada N; la métrica aceptada cuenta por N en los contadores
+    thread_local std::minstd_rand rng{ std::random_device{}() };
+    auto rate = static_cast<uint32_t>(g_config.ingest_sample_rate);
+    if (rng() % rate != 0) {
+        metrics_processor->record_sampled_out();
+        res.set_content(kMetricSampledResponse.data(), kMetricSampledResponse.size(), "application/json");
+        return false;
+    }
+
+    weight = rate;
+    return true;
+}
+
+void HttpServer::setup_admin_routes(httplib::Server& target) {
+    target.Get("/info", [](const httplib::Request&, httplib::Response& res) {
         nlohmann::json info = {
             {"service", "btech-metrics-service"},
             {"version", "1.0.0"},
             {"description", "Real-time metrics processing for microservices"},
             {"endpoints", {
-                "GET /health - Basic health check",
-                "GET /health/detailed - Detailed health information",
-                "POST /metrics - Submit metrics data",
-                "GET /metrics/realtime - Get real-time metrics",
-                "GET /metrics/endpoint/{endpoint} - Get specific endpoint metrics",
-                "GET /info - Service information"
+                "POST /metrics - Submit metrics data (ingest port)",
+                "GET /health - Basic health check (control and ingest ports)",
+                "GET /health/detailed - Detailed health information (control port)",
+                "GET /metrics/realtime - Get real-time metrics (control port)",
+                "GET /metrics/endpoint/{endpoint} - Get specific endpoint metrics (control port)",
+                "GET /metrics/prometheus - OpenMetrics exposition with trace exemplars (control port)",
+                "GET /info - Service information (control port)"
             }}
         };
         res.set_content(info.dump(2), "application/json");
         });
 }
 
-void HttpServer::start(int port) {
-    spdlog::info("Starting HTTP server on port {}", port);
-    spdlog::info("Available endpoints:");
-    spdlog::info("  GET  /health - Health check");
+bool HttpServer::start(int port) {
+    spdlog::info("Starting HTTP ingest server on port {}", port);
     spdlog::info("  POST /metrics - Submit metrics");
+    spdlog::info("  GET  /health - Health check");
+    spdlog::info("  GET  query routes - Deprecated here, use port {}", g_config.control_port);
+    spdlog::info("Starting HTTP control server on port {}", g_config.control_port);
+    spdlog::info("  GET  /health - Health check");
     spdlog::info("  GET  /metrics/realtime - Real-time metrics");
+    spdlog::info("  GET  /metrics/prometheus - OpenMetrics with exemplars");
     spdlog::info("  GET  /info - Service info");
 
-    server.listen("0.0.0.0", port);
+    // Ambos puertos se abren aquí, antes de lanzar ningún hilo, para que un
+    // fallo de bind se reporte al llamador y no deje un servidor a medias
+    if (!control_server.bind_to_port("0.0.0.0", g_config.control_port)) {
+        spdlog::error("Control server failed to bind port {}", g_config.control_port);
+        return false;
+    }
+    if (!server.bind_to_port("0.0.0.0", port)) {
+        spdlog::error("Ingest server failed to bind port {}", port);
+        return false;
+    }
+
+    control_thread = std::thread([this] {
+        control_server.listen_after_bind();
+        control_stopped = true;
+        });
+    ingest_thread = std::thread([this] {
+        server.listen_after_bind();
+        ingest_stopped = true;
+        });
+    return true;
+}
+
+bool HttpServer::running() const {
+    return !ingest_stopped && !control_stopped;
 }
 
 void HttpServer::stop() {
-    server.stop();
+    if (!ingest_thread.joinable() && !control_thread.joinable()) {
+        return;
+    }
+
+    // httplib ignora stop() si listen aún no ha empezado en su hilo, así que
+    // se repite hasta que los dos bucles de listen han terminado
+    while (!ingest_stopped || !control_stopped) {
+        server.stop();
+        control_server.stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ingest_thread.join();
+    control_thread.join();
     spdlog::info("HTTP server stopped");
-}
\ No newline at end of file
+}
@@ -1,22 +1,44 @@
 #pragma once
 #include <httplib.h>
 #include <memory>
+#include <atomic>
+#include <thread>
 #include "MetricsProcessor.h"
 
 class HttpServer {
 private:
+    // Ingesta (POST /metrics) y /health en PORT; health, consultas y admin en
+    // CONTROL_PORT (las rutas de lectura en PORT quedan como deprecated)
     httplib::Server server;
+    httplib::Server control_server;
+    // Los hilos de listen solo se crean y se unen desde el hilo que llama a
+    // start()/stop()
+    std::thread ingest_thread;
+    std::thread control_thread;
+    std::atomic<bool> ingest_stopped{ false };
+    std::atomic<bool> control_stopped{ false };
     std::shared_ptr<MetricsProcessor> metrics_processor;
 
+    std::atomic<int> queued_connections{ 0 };
+    std::atomic<int> pinned_connections{ 0 };
+    std::atomic<int> ingest_in_flight{ 0 };
+
 public:
     explicit HttpServer(std::shared_ptr<MetricsProcessor> processor);
+    ~HttpServer();
     void setup_routes();
-    void start(int port);
+    bool start(int port);
+    bool running() const;
     void stop();
 
 private:
-    void setup_cors();
-    void setup_health_routes();
-    void setup_metrics_routes();
-    void setup_admin_routes();
+    void setup_task_queues();
+    void setup_cors(httplib::Server& target);
+    void setup_health_routes(httplib::Server& target);
+    void setup_ingest_routes();
+    void setup_query_routes(httplib::Server& target);
+    void setup_exposition_routes();
+    void setup_admin_routes(httplib::Server& target);
+    void setup_legacy_routes();
+    bool admit_ingest(httplib::Response& res, uint64_t& weight);
 };
\ No newline at end of file
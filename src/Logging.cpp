@@ -0,0 +1,53 @@
+#include "Logging.h"
+#include <spdlog/async.h>
+#include <spdlog/details/thread_pool.h>
+
+namespace {
+
+void append_json_escaped(spdlog::string_view_t text, spdlog::memory_buf_t& dest) {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    for (char c : text) {
+        switch (c) {
+        case '"': dest.append(std::string_view("\\\"")); break;
+        case '\\': dest.append(std::string_view("\\\\")); break;
+        case '\n': dest.append(std::string_view("\\n")); break;
+        case '\r': dest.append(std::string_view("\\r")); break;
+        case '\t': dest.append(std::string_view("\\t")); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[] = { '\\', 'u', '0', '0',
+                    kHex[(c >> 4) & 0xF], kHex[c & 0xF] };
+                dest.append(escaped, escaped + sizeof(escaped));
+            }
+            else {
+                dest.push_back(c);
+            }
+        }
+    }
+}
+
+}
+
+void JsonLogFormatter::format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) {
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        msg.time.time_since_epoch()).count();
+    auto level = spdlog::level::to_string_view(msg.level);
+
+    fmt::format_to(std::back_inserter(dest),
+        R"({{"ts_ms":{},"level":"{}","thread":{},"logger":")",
+        millis, std::string_view(level.data(), level.size()), msg.thread_id);
+    append_json_escaped(msg.logger_name, dest);
+    dest.append(std::string_view(R"(","msg":")"));
+    append_json_escaped(msg.payload, dest);
+    dest.append(std::string_view("\"}\n"));
+}
+
+std::unique_ptr<spdlog::formatter> JsonLogFormatter::clone() const {
+    return std::make_unique<JsonLogFormatter>();
+}
+
+size_t dropped_log_messages() {
+    auto pool = spdlog::thread_pool();
+    return pool ? pool->overrun_counter() : 0;
+}
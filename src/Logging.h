@@ -0,0 +1,71 @@
+#pragma once
+#include <spdlog/spdlog.h>
+#include <spdlog/formatter.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "Config.h"
+
+// Formatter de una línea JSON por mensaje (LOG_FORMAT=json)
+class JsonLogFormatter : public spdlog::formatter {
+public:
+    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override;
+    std::unique_ptr<spdlog::formatter> clone() const override;
+};
+
+// Limitador por call site para logs del hot path: deja pasar como mucho
+// g_config.log_rate_limit_per_second mensajes por segundo y cuenta el resto.
+class LogRateLimiter {
+private:
+    // Segundo de la ventana (32 bits altos) y mensajes emitidos en ella (32
+    // bits bajos), para que el cambio de ventana y el conteo sean un solo CAS
+    std::atomic<uint64_t> window_state{ 0 };
+    std::atomic<uint64_t> suppressed{ 0 };
+
+public:
+    bool allow(uint64_t& suppressed_before) {
+        auto now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        auto limit = static_cast<uint32_t>(std::max(1, g_config.log_rate_limit_per_second));
+
+        uint64_t state = window_state.load(std::memory_order_relaxed);
+        uint64_t next;
+        do {
+            auto window = static_cast<uint32_t>(state >> 32);
+            auto count = static_cast<uint32_t>(state);
+
+            // Un hilo que leyó el reloj antes no debe reabrir una ventana pasada
+            if (now > window) {
+                window = now;
+                count = 0;
+            }
+            if (count >= limit) {
+                suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            next = (static_cast<uint64_t>(window) << 32) | (count + 1);
+        } while (!window_state.compare_exchange_weak(state, next, std::memory_order_relaxed));
+
+        suppressed_before = suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+// Mensajes descartados por la cola del logger asíncrono (0 en modo síncrono)
+size_t dropped_log_messages();
+
+#define LOG_RATE_LIMITED(lvl, ...)                                                          \
+    do {                                                                                    \
+        if (spdlog::default_logger_raw()->should_log(lvl)) {                                \
+            static LogRateLimiter log_rate_limiter_;                                        \
+            uint64_t log_suppressed_ = 0;                                                   \
+            if (log_rate_limiter_.allow(log_suppressed_)) {                                 \
+                if (log_suppressed_ > 0) {                                                  \
+                    spdlog::log(lvl, "{} similar messages suppressed", log_suppressed_);    \
+                }                                                                           \
+                spdlog::log(lvl, __VA_ARGS__);                                              \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
@@ -0,0 +1,489 @@
+#include "MetricParser.h"
+#include "MetricSchema.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr size_t kMaxNestingDepth = 64;
+constexpr size_t kMaxKeyLength = 64;
+
+// Escáner JSON mínimo para el payload plano de POST /metrics. Escribe los
+// campos del esquema directamente en el Metric (cuyos strings viven en la
+// arena del request) y valida y salta el resto sin reservar memoria.
+template <typename Schema>
+class MetricScanner {
+private:
+    static constexpr auto& kFields = Schema::fields;
+
+    struct NumberToken {
+        const char* first;
+        const char* last;
+        bool negative;
+        bool integral;
+    };
+
+    const char* begin;
+    const char* pos;
+    const char* end;
+    Metric& metric;
+    uint32_t seen = 0;
+
+public:
+    MetricScanner(std::string_view body, Metric& m)
+        : begin(body.data()), pos(body.data()), end(body.data() + body.size()), metric(m) {}
+
+    void parse() {
+        skip_whitespace();
+        if (pos == end || *pos != '{') {
+            throw std::invalid_argument("Metric payload must be a JSON object");
+        }
+        ++pos;
+
+        skip_whitespace();
+        if (pos != end && *pos == '}') {
+            ++pos;
+        }
+        else {
+            while (true) {
+                char key[kMaxKeyLength];
+                size_t key_length = 0;
+                bool key_fits = true;
+
+                expect('"', "expected object key");
+                read_string([&](const char* data, size_t size) {
+                    if (!key_fits || key_length + size > kMaxKeyLength) {
+                        key_fits = false;
+                        return;
+                    }
+                    std::memcpy(key + key_length, data, size);
+                    key_length += size;
+                    });
+
+                skip_whitespace();
+                expect(':', "expected ':' after object key");
+                skip_whitespace();
+
+                size_t index = key_fits ?
+                    schema_field_index<Schema>(std::string_view(key, key_length)) : kFields.size();
+                if (index < kFields.size()) {
+                    read_field(index);
+                }
+                else {
+                    skip_value(1);
+                }
+
+                skip_whitespace();
+                if (pos != end && *pos == ',') {
+                    ++pos;
+                    skip_whitespace();
+                    continue;
+                }
+                expect('}', "expected ',' or '}' after object member");
+                break;
+            }
+        }
+
+        skip_whitespace();
+        if (pos != end) {
+            fail("unexpected characters after the JSON object");
+        }
+
+        finish();
+    }
+
+private:
+    [[noreturn]] void fail(const char* message) const {
+        throw std::invalid_argument("Invalid JSON at offset " +
+            std::to_string(pos - begin) + ": " + message);
+    }
+
+    [[noreturn]] void invalid_type(size_t index) const {
+        throw std::invalid_argument("Invalid type for field: " + std::string(kFields[index].name));
+    }
+
+    void skip_whitespace() {
+        while (pos != end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')) {
+            ++pos;
+        }
+    }
+
+    void expect(char c, const char* message) {
+        if (pos == end || *pos != c) {
+            fail(message);
+        }
+        ++pos;
+    }
+
+    static bool is_number_start(char c) {
+        return c == '-' || (c >= '0' && c <= '9');
+    }
+
+    void read_field(size_t index) {
+        if (pos == end) {
+            fail("unexpected end of input");
+        }
+
+        switch (kFields[index].field) {
+        case MetricField::Endpoint: read_string_field(index, metric.endpoint); break;
+        case MetricField::Method: read_string_field(index, metric.method); break;
+        case MetricField::TraceId: read_string_field(index, metric.trace_id); break;
+        case MetricField::ServiceName: read_string_field(index, metric.service_name); break;
+        case MetricField::UserId: read_string_field(index, metric.user_id); break;
+        case MetricField::IpAddress: read_string_field(index, metric.ip_address); break;
+        case MetricField::Duration: read_unsigned_field(index, metric.duration_ms); break;
+        case MetricField::Timestamp: read_unsigned_field(index, metric.timestamp); break;
+        case MetricField::Status:
+            if (*pos == '"') {
+                ++pos;
+                metric.status.clear();
+                read_string([&](const char* data, size_t size) { metric.status.append(data, size); });
+                metric.status_class = classify_status(metric.status);
+            }
+            else if (is_number_start(*pos)) {
+                uint64_t code = read_unsigned(index);
+                char digits[24];
+                auto [last, ec] = std::to_chars(digits, digits + sizeof(digits), code);
+                metric.status.assign(digits, last);
+                metric.status_class = classify_status_code(code);
+            }
+            else {
+                invalid_type(index);
+            }
+            break;
+        }
+
+        seen |= 1u << index;
+    }
+
+    void read_string_field(size_t index, std::pmr::string& target) {
+        if (*pos != '"') invalid_type(index);
+        ++pos;
+        target.clear();
+        read_string([&](const char* data, size_t size) { target.append(data, size); });
+    }
+
+    void read_unsigned_field(size_t index, uint64_t& target) {
+        if (!is_number_start(*pos)) invalid_type(index);
+        target = read_unsigned(index);
+    }
+
+    uint64_t read_unsigned(size_t index) {
+        auto token = scan_number();
+        if (token.negative) {
+            invalid_type(index);
+        }
+
+        if (token.integral) {
+            uint64_t value = 0;
+            auto [last, ec] = std::from_chars(token.first, token.last, value);
+            if (ec != std::errc() || last != token.last) {
+                invalid_type(index);
+            }
+            return value;
+        }
+
+        double value = 0;
+        auto [last, ec] = std::from_chars(token.first, token.last, value);
+        // 2^64 es exacto en double; todo lo que no quepa en uint64_t es inválido
+        if (ec != std::errc() || last != token.last ||
+            !std::isfinite(value) || value >= 18446744073709551616.0) {
+            invalid_type(index);
+        }
+        return static_cast<uint64_t>(value);
+    }
+
+    NumberToken scan_number() {
+        NumberToken token{ pos, pos, false, true };
+
+        if (*pos == '-') {
+            token.negative = true;
+            ++pos;
+        }
+
+        if (pos == end || *pos < '0' || *pos > '9') fail("invalid number");
+        if (*pos == '0') {
+            ++pos;
+        }
+        else {
+            while (pos != end && *pos >= '0' && *pos <= '9') ++pos;
+        }
+
+        if (pos != end && *pos == '.') {
+            token.integral = false;
+            ++pos;
+            if (pos == end || *pos < '0' || *pos > '9') fail("invalid number");
+            while (pos != end && *pos >= '0' && *pos <= '9') ++pos;
+        }
+
+        if (pos != end && (*pos == 'e' || *pos == 'E')) {
+            token.integral = false;
+            ++pos;
+            if (pos != end && (*pos == '+' || *pos == '-')) ++pos;
+            if (pos == end || *pos < '0' || *pos > '9') fail("invalid number");
+            while (pos != end && *pos >= '0' && *pos <= '9') ++pos;
+        }
+
+        token.last = pos;
+        return token;
+    }
+
+    // Lee el string que empieza tras la comilla inicial y entrega a `append`
+    // tramos ya decodificados, sin buffers intermedios
+    template <typename Append>
+    void read_string(Append&& append) {
+        const char* run = pos;
+
+        while (true) {
+            if (pos == end) fail("unterminated string");
+
+            char c = *pos;
+            if (c == '"') {
+                if (pos != run) append(run, static_cast<size_t>(pos - run));
+                ++pos;
+                return;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fail("control character in string");
+            }
+            if (static_cast<unsigned char>(c) >= 0x80) {
+                skip_utf8_sequence();
+                continue;
+            }
+            if (c != '\\') {
+                ++pos;
+                continue;
+            }
+
+            if (pos != run) append(run, static_cast<size_t>(pos - run));
+            ++pos;
+            if (pos == end) fail("unterminated string");
+
+            char decoded;
+            switch (*pos) {
+            case '"': decoded = '"'; break;
+            case '\\': decoded = '\\'; break;
+            case '/': decoded = '/'; break;
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u': {
+                ++pos;
+                char utf8[4];
+                size_t length = decode_unicode_escape(utf8);
+                append(utf8, length);
+                run = pos;
+                continue;
+            }
+            default:
+                fail("invalid escape sequence");
+            }
+
+            append(&decoded, 1);
+            ++pos;
+            run = pos;
+        }
+    }
+
+    // Valida y salta una secuencia UTF-8 multibyte: rechaza bytes de
+    // continuación sueltos, secuencias truncadas, overlongs, surrogates y
+    // valores por encima de U+10FFFF, como hacía nlohmann::json
+    void skip_utf8_sequence() {
+        auto lead = static_cast<unsigned char>(*pos);
+        size_t length;
+        unsigned char second_min = 0x80;
+        unsigned char second_max = 0xBF;
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0) second_min = 0xA0;
+            if (lead == 0xED) second_max = 0x9F;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0) second_min = 0x90;
+            if (lead == 0xF4) second_max = 0x8F;
+        }
+        else {
+            fail("invalid UTF-8 byte");
+        }
+
+        if (static_cast<size_t>(end - pos) < length) {
+            fail("invalid UTF-8 byte");
+        }
+        auto second = static_cast<unsigned char>(pos[1]);
+        if (second < second_min || second > second_max) {
+            fail("invalid UTF-8 byte");
+        }
+        for (size_t i = 2; i < length; ++i) {
+            if ((static_cast<unsigned char>(pos[i]) & 0xC0) != 0x80) {
+                fail("invalid UTF-8 byte");
+            }
+        }
+        pos += length;
+    }
+
+    uint32_t read_hex4() {
+        if (end - pos < 4) fail("invalid unicode escape");
+
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i, ++pos) {
+            char c = *pos;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else fail("invalid unicode escape");
+        }
+        return value;
+    }
+
+    size_t decode_unicode_escape(char* out) {
+        uint32_t code_point = read_hex4();
+
+        if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+            fail("unpaired low surrogate");
+        }
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+            if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') {
+                fail("unpaired high surrogate");
+            }
+            pos += 2;
+            uint32_t low = read_hex4();
+            if (low < 0xDC00 || low > 0xDFFF) {
+                fail("invalid low surrogate");
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (code_point < 0x80) {
+            out[0] = static_cast<char>(code_point);
+            return 1;
+        }
+        if (code_point < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+            out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 2;
+        }
+        if (code_point < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+            out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+
+    void skip_literal(std::string_view literal) {
+        if (static_cast<size_t>(end - pos) < literal.size() ||
+            std::string_view(pos, literal.size()) != literal) {
+            fail("invalid literal");
+        }
+        pos += literal.size();
+    }
+
+    void skip_value(size_t depth) {
+        if (depth > kMaxNestingDepth) fail("nesting too deep");
+        if (pos == end) fail("unexpected end of input");
+
+        switch (*pos) {
+        case '"':
+            ++pos;
+            read_string([](const char*, size_t) {});
+            return;
+        case 't':
+            skip_literal("true");
+            return;
+        case 'f':
+            skip_literal("false");
+            return;
+        case 'n':
+            skip_literal("null");
+            return;
+        case '{':
+            ++pos;
+            skip_whitespace();
+            if (pos != end && *pos == '}') {
+                ++pos;
+                return;
+            }
+            while (true) {
+                expect('"', "expected object key");
+                read_string([](const char*, size_t) {});
+                skip_whitespace();
+                expect(':', "expected ':' after object key");
+                skip_whitespace();
+                skip_value(depth + 1);
+                skip_whitespace();
+                if (pos != end && *pos == ',') {
+                    ++pos;
+                    skip_whitespace();
+                    continue;
+                }
+                expect('}', "expected ',' or '}' after object member");
+                return;
+            }
+        case '[':
+            ++pos;
+            skip_whitespace();
+            if (pos != end && *pos == ']') {
+                ++pos;
+                return;
+            }
+            while (true) {
+                skip_value(depth + 1);
+                skip_whitespace();
+                if (pos != end && *pos == ',') {
+                    ++pos;
+                    skip_whitespace();
+                    continue;
+                }
+                expect(']', "expected ',' or ']' after array element");
+                return;
+            }
+        default:
+            if (is_number_start(*pos)) {
+                scan_number();
+                return;
+            }
+            fail("unexpected character");
+        }
+    }
+
+    void finish() {
+        constexpr uint32_t required = schema_required_mask<Schema>();
+        if ((seen & required) != required) {
+            for (size_t i = 0; i < kFields.size(); ++i) {
+                if (kFields[i].required && !(seen & (1u << i))) {
+                    throw std::invalid_argument("Missing required field: " + std::string(kFields[i].name));
+                }
+            }
+        }
+
+        constexpr size_t service_name_index = schema_field_index<Schema>(MetricField::ServiceName);
+        if constexpr (service_name_index < kFields.size()) {
+            if (!(seen & (1u << service_name_index))) {
+                metric.service_name = "unknown";
+            }
+        }
+    }
+};
+
+}
+
+void parse_metric(std::string_view body, Metric& metric) {
+    MetricScanner<DefaultMetricSchema> scanner(body, metric);
+    scanner.parse();
+}
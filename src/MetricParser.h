@@ -0,0 +1,9 @@
+#pragma once
+#include "MetricsProcessor.h"
+#include <string_view>
+
+// Parsea el cuerpo de POST /metrics directamente sobre el Metric con un
+// escáner propio, sin construir el árbol nlohmann::json ni reservar memoria
+// fuera del allocator del Metric. Lanza std::invalid_argument si el JSON es
+// inválido o falta algún campo obligatorio.
+void parse_metric(std::string_view body, Metric& metric);
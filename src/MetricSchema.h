@@ -0,0 +1,153 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Clase de status de una métrica, resuelta una sola vez al parsear
+enum class StatusClass : uint8_t {
+    Unknown,
+    Informational,
+    Success,
+    Redirect,
+    ClientError,
+    ServerError
+};
+
+constexpr size_t kStatusClassCount = 6;
+
+constexpr std::array<std::string_view, kStatusClassCount> kStatusClassNames = {
+    "unknown", "1xx", "2xx", "3xx", "4xx", "5xx"
+};
+
+// Primer dígito del código HTTP -> clase
+constexpr std::array<StatusClass, 10> kStatusClassByLeadingDigit = {
+    StatusClass::Unknown,
+    StatusClass::Informational,
+    StatusClass::Success,
+    StatusClass::Redirect,
+    StatusClass::ClientError,
+    StatusClass::ServerError,
+    StatusClass::Unknown,
+    StatusClass::Unknown,
+    StatusClass::Unknown,
+    StatusClass::Unknown
+};
+
+constexpr StatusClass classify_status_code(uint64_t code) {
+    if (code < 100 || code > 999) {
+        return StatusClass::Unknown;
+    }
+    return kStatusClassByLeadingDigit[code / 100];
+}
+
+constexpr StatusClass classify_status(std::string_view status) {
+    if (status.size() == 3 &&
+        status[0] >= '0' && status[0] <= '9' &&
+        status[1] >= '0' && status[1] <= '9' &&
+        status[2] >= '0' && status[2] <= '9') {
+        return kStatusClassByLeadingDigit[status[0] - '0'];
+    }
+
+    if (status == "success") {
+        return StatusClass::Success;
+    }
+    return StatusClass::Unknown;
+}
+
+// Solo 4xx, 5xx y los status no reconocidos cuentan como error; 1xx y 3xx
+// suman en success_count junto a 2xx (antes solo "200" y "success" lo hacían)
+constexpr bool is_error_status(StatusClass status_class) {
+    return status_class == StatusClass::ClientError ||
+        status_class == StatusClass::ServerError ||
+        status_class == StatusClass::Unknown;
+}
+
+static_assert(classify_status("200") == StatusClass::Success);
+static_assert(classify_status("204") == StatusClass::Success);
+static_assert(classify_status("success") == StatusClass::Success);
+static_assert(classify_status("503") == StatusClass::ServerError);
+static_assert(classify_status("error") == StatusClass::Unknown);
+static_assert(classify_status("ok") == StatusClass::Unknown);
+static_assert(classify_status_code(201) == StatusClass::Success);
+static_assert(!is_error_status(classify_status("304")));
+static_assert(!is_error_status(classify_status("101")));
+
+enum class MetricField : uint8_t {
+    Endpoint,
+    Method,
+    Duration,
+    Status,
+    Timestamp,
+    TraceId,
+    ServiceName,
+    UserId,
+    IpAddress
+};
+
+// El tipo JSON de cada campo lo fija el miembro de Metric en el que se guarda
+struct FieldSpec {
+    std::string_view name;
+    MetricField field;
+    bool required;
+};
+
+// Agregaciones que mantiene cada endpoint para un esquema
+enum Aggregation : uint32_t {
+    kAggregateCounts = 1u << 0,
+    kAggregateStatusClasses = 1u << 1,
+    kAggregateLatency = 1u << 2,
+    kAggregateExemplars = 1u << 3
+};
+
+// Esquema del payload de POST /metrics: layout de campos y agregaciones.
+// El parser y el procesador se especializan sobre él en tiempo de compilación.
+struct DefaultMetricSchema {
+    static constexpr std::array<FieldSpec, 9> fields = { {
+        {"endpoint", MetricField::Endpoint, true},
+        {"method", MetricField::Method, true},
+        {"duration", MetricField::Duration, true},
+        {"status", MetricField::Status, true},
+        {"timestamp", MetricField::Timestamp, true},
+        {"trace_id", MetricField::TraceId, false},
+        {"service_name", MetricField::ServiceName, false},
+        {"user_id", MetricField::UserId, false},
+        {"ip_address", MetricField::IpAddress, false}
+    } };
+
+    static constexpr uint32_t aggregations =
+        kAggregateCounts | kAggregateStatusClasses | kAggregateLatency | kAggregateExemplars;
+};
+
+template <typename Schema>
+constexpr size_t schema_field_index(std::string_view name) {
+    for (size_t i = 0; i < Schema::fields.size(); ++i) {
+        if (Schema::fields[i].name == name) return i;
+    }
+    return Schema::fields.size();
+}
+
+template <typename Schema>
+constexpr size_t schema_field_index(MetricField field) {
+    for (size_t i = 0; i < Schema::fields.size(); ++i) {
+        if (Schema::fields[i].field == field) return i;
+    }
+    return Schema::fields.size();
+}
+
+template <typename Schema>
+constexpr uint32_t schema_required_mask() {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < Schema::fields.size(); ++i) {
+        if (Schema::fields[i].required) mask |= 1u << i;
+    }
+    return mask;
+}
+
+template <typename Schema>
+constexpr bool schema_aggregates(uint32_t aggregation) {
+    return (Schema::aggregations & aggregation) != 0;
+}
+
+static_assert(DefaultMetricSchema::fields.size() <= 32, "field mask is 32 bits");
+static_assert(schema_field_index<DefaultMetricSchema>("status") == 3);
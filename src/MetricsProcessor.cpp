@@ -1,5 +1,6 @@
 ﻿#include "MetricsProcessor.h"
 #include "Config.h"
+#include "Logging.h"
 #include <spdlog/spdlog.h>
 #include <algorithm>
 #include <numeric>
@@ -9,40 +10,80 @@ MetricsProcessor::MetricsProcessor() {
     spdlog::info("MetricsProcessor initialized");
 }
 
-void MetricsProcessor::process_metric(const Metric& metric) {
-    std::string key = make_endpoint_key(metric.method, metric.endpoint);
+void MetricsProcessor::process_metric(const Metric& metric, uint64_t weight) {
+    auto key = make_endpoint_key(metric);
 
-    total_requests++;
+    total_requests += weight;
 
-    std::unique_ptr<EndpointStats>* stats_ptr;
+    EndpointStats* stats_ptr;
     {
         std::lock_guard<std::mutex> lock(stats_mutex);
-        if (endpoint_stats.find(key) == endpoint_stats.end()) {
-            endpoint_stats[key] = std::make_unique<EndpointStats>();
+        auto it = endpoint_stats.find(std::string_view(key));
+        if (it == endpoint_stats.end()) {
+            it = endpoint_stats.emplace(std::string(key), std::make_unique<EndpointStats>()).first;
         }
-        stats_ptr = &endpoint_stats[key];
+        stats_ptr = it->second.get();
     }
 
-    auto& stats = **stats_ptr;
+    auto& stats = *stats_ptr;
 
-    stats.request_count++;
-    stats.last_request = std::chrono::steady_clock::now();
+    if (aggregate_metric<DefaultMetricSchema>(stats, metric, weight, g_config.exemplar_window_seconds)) {
+        total_errors += weight;
+    }
 
-    if (metric.status == "success" || metric.status == "200") {
-        stats.success_count++;
+    if (is_anomaly(metric, stats)) {
+        trigger_alerts(metric, key);
     }
-    else {
-        stats.error_count++;
-        total_errors++;
+
+    spdlog::debug("Processed metric: {} - {}ms - {}", key, metric.duration_ms, metric.status);
+}
+
+nlohmann::json MetricsProcessor::status_classes_json(const EndpointStats& stats) const {
+    nlohmann::json result = nlohmann::json::object();
+    for (size_t i = 0; i < kStatusClassCount; ++i) {
+        result[std::string(kStatusClassNames[i])] = stats.status_class_counts[i].load();
     }
+    return result;
+}
+
+nlohmann::json MetricsProcessor::exemplars_json(const EndpointStats& stats) const {
+    auto to_json = [](const Exemplar& exemplar) {
+        return nlohmann::json{
+            {"trace_id", exemplar.trace()},
+            {"duration_ms", exemplar.value_ms},
+            {"timestamp_ms", exemplar.timestamp_ms}
+        };
+    };
 
-    stats.latency_buffer->push(static_cast<double>(metric.duration_ms));
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    auto window = exemplar_window(now_ms, g_config.exemplar_window_seconds);
 
-    if (is_anomaly(metric)) {
-        trigger_alerts(metric);
+    nlohmann::json slowest = nlohmann::json::array();
+    std::array<Exemplar, kSlowestExemplarsPerEndpoint> snapshot;
+    auto count = stats.slowest_exemplars.snapshot(window, snapshot);
+    for (size_t i = 0; i < count; ++i) {
+        slowest.push_back(to_json(snapshot[i]));
     }
 
-    spdlog::debug("Processed metric: {} - {}ms - {}", key, metric.duration_ms, metric.status);
+    nlohmann::json buckets = nlohmann::json::array();
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        nlohmann::json bucket = {
+            {"le", i < kLatencyBucketBoundsMs.size() ? nlohmann::json(kLatencyBucketBoundsMs[i]) : nlohmann::json("+Inf")},
+            {"count", stats.latency_histogram.count(i)}
+        };
+
+        Exemplar exemplar;
+        bucket["exemplar"] = stats.latency_histogram.exemplar(i, exemplar) ? to_json(exemplar) : nlohmann::json(nullptr);
+        buckets.push_back(bucket);
+    }
+
+    return {
+        {"window_seconds", g_config.exemplar_window_seconds},
+        {"window_start_ms", exemplar_window_start_ms(window, g_config.exemplar_window_seconds)},
+        {"slowest", slowest},
+        {"histogram", buckets}
+    };
 }
 
 nlohmann::json MetricsProcessor::get_realtime_metrics() {
@@ -72,6 +113,7 @@ nlohmann::json MetricsProcessor::get_realtime_metrics() {
         endpoint_data["request_count"] = stats->request_count.load();
         endpoint_data["error_count"] = stats->error_count.load();
         endpoint_data["success_count"] = stats->success_count.load();
+        endpoint_data["status_classes"] = status_classes_json(*stats);
 
         auto error_rate = stats->request_count > 0 ?
             static_cast<double>(stats->error_count) / stats->request_count * 100 : 0.0;
@@ -114,7 +156,8 @@ nlohmann::json MetricsProcessor::get_endpoint_metrics(const std::string& endpoin
             {"endpoint", endpoint},
             {"request_count", stats->request_count.load()},
             {"error_count", stats->error_count.load()},
-            {"success_count", stats->success_count.load()}
+            {"success_count", stats->success_count.load()},
+            {"status_classes", status_classes_json(*stats)}
         };
 
         auto error_rate = stats->request_count > 0 ?
@@ -138,6 +181,7 @@ nlohmann::json MetricsProcessor::get_endpoint_metrics(const std::string& endpoin
         auto last_request_ago = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::steady_clock::now() - stats->last_request).count();
         result["last_request_seconds_ago"] = last_request_ago;
+        result["exemplars"] = exemplars_json(*stats);
     }
     else {
         nlohmann::json similar_endpoints = nlohmann::json::array();
@@ -190,6 +234,10 @@ nlohmann::json MetricsProcessor::get_system_health() {
         {"total_errors", total_errors.load()},
         {"error_rate_percent", error_rate},
         {"endpoints_count", endpoint_stats.size()},
+        {"load_shedding", {
+            {"shed_requests", total_shed.load()},
+            {"sampled_out_requests", total_sampled_out.load()}
+        }},
         {"service", "metrics-service"},
         {"version", "1.0.0"}
     };
@@ -197,38 +245,118 @@ nlohmann::json MetricsProcessor::get_system_health() {
     return health;
 }
 
+std::string MetricsProcessor::get_prometheus_metrics() {
+    auto escape_label = [](std::string_view value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                escaped.push_back('\\');
+                escaped.push_back(c);
+            }
+            else if (c == '\n') {
+                escaped.append("\\n");
+            }
+            else {
+                escaped.push_back(c);
+            }
+        }
+        return escaped;
+    };
+
+    std::string requests;
+    std::string errors;
+    std::string latency;
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (const auto& [key, stats] : endpoint_stats) {
+        // La clave es "METHOD:/path"; el path puede contener ':'
+        std::string_view key_view(key);
+        auto separator = key_view.find(':');
+        auto label = fmt::format("method=\"{}\",endpoint=\"{}\"",
+            escape_label(key_view.substr(0, separator)), escape_label(key_view.substr(separator + 1)));
+
+        requests += fmt::format("endpoint_requests_total{{{}}} {}\n",
+            label, stats->request_count.load());
+        errors += fmt::format("endpoint_errors_total{{{}}} {}\n",
+            label, stats->error_count.load());
+
+        const auto& histogram = stats->latency_histogram;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+            cumulative += histogram.count(i);
+            auto le = i < kLatencyBucketBoundsMs.size() ? std::to_string(kLatencyBucketBoundsMs[i]) : std::string("+Inf");
+
+            latency += fmt::format("endpoint_latency_milliseconds_bucket{{{},le=\"{}\"}} {}",
+                label, le, cumulative);
+
+            Exemplar exemplar;
+            if (histogram.exemplar(i, exemplar)) {
+                latency += fmt::format(" # {{trace_id=\"{}\"}} {} {:.3f}",
+                    escape_label(exemplar.trace()), exemplar.value_ms, exemplar.timestamp_ms / 1000.0);
+            }
+            latency += "\n";
+        }
+        latency += fmt::format("endpoint_latency_milliseconds_count{{{}}} {}\n", label, cumulative);
+        latency += fmt::format("endpoint_latency_milliseconds_sum{{{}}} {}\n", label, histogram.sum());
+    }
+
+    return "# TYPE endpoint_requests counter\n" + requests +
+        "# TYPE endpoint_errors counter\n" + errors +
+        "# TYPE endpoint_latency_milliseconds histogram\n"
+        "# UNIT endpoint_latency_milliseconds milliseconds\n" + latency +
+        "# EOF\n";
+}
+
 bool MetricsProcessor::is_anomaly(const Metric& metric) {
     if (metric.duration_ms > static_cast<uint64_t>(g_config.alert_threshold_ms))
         return true;
 
-    std::string key = make_endpoint_key(metric.method, metric.endpoint);
+    auto key = make_endpoint_key(metric);
     std::lock_guard<std::mutex> lock(stats_mutex);
 
-    auto it = endpoint_stats.find(key);
+    auto it = endpoint_stats.find(std::string_view(key));
     if (it != endpoint_stats.end()) {
-        auto& stats = it->second;
-        auto error_rate = stats->request_count > 10 ?
-            static_cast<double>(stats->error_count) / stats->request_count * 100 : 0.0;
-
-        if (error_rate > 20.0) {
-            return true;
-        }
+        return is_anomaly(metric, *it->second);
     }
 
     return false;
 }
 
+bool MetricsProcessor::is_anomaly(const Metric& metric, const EndpointStats& stats) {
+    if (metric.duration_ms > static_cast<uint64_t>(g_config.alert_threshold_ms))
+        return true;
+
+    auto request_count = stats.request_count.load();
+    auto error_rate = request_count > 10 ?
+        static_cast<double>(stats.error_count) / request_count * 100 : 0.0;
+
+    return error_rate > 20.0;
+}
+
 void MetricsProcessor::add_alert_handler(std::function<void(const Metric&)> handler) {
     alert_handlers.push_back(std::move(handler));
 }
 
-std::string MetricsProcessor::make_endpoint_key(const std::string& method, const std::string& endpoint) {
-    return method + ":" + endpoint;
+void MetricsProcessor::record_shed() {
+    total_shed++;
+}
+
+void MetricsProcessor::record_sampled_out() {
+    total_sampled_out++;
+}
+
+std::pmr::string MetricsProcessor::make_endpoint_key(const Metric& metric) {
+    // La clave vive en el mismo recurso que el Metric (la arena del request en la ingesta)
+    std::pmr::string key(metric.endpoint.get_allocator());
+    key.reserve(metric.method.size() + 1 + metric.endpoint.size());
+    key.append(metric.method).append(":").append(metric.endpoint);
+    return key;
 }
 
-void MetricsProcessor::trigger_alerts(const Metric& metric) {
-    spdlog::warn("Anomaly detected: {} {}ms - {}",
-        make_endpoint_key(metric.method, metric.endpoint),
+void MetricsProcessor::trigger_alerts(const Metric& metric, std::string_view key) {
+    LOG_RATE_LIMITED(spdlog::level::warn, "Anomaly detected: {} {}ms - {}",
+        key,
         metric.duration_ms,
         metric.status);
 
@@ -237,7 +365,7 @@ void MetricsProcessor::trigger_alerts(const Metric& metric) {
             handler(metric);
         }
         catch (const std::exception& e) {
-            spdlog::error("Error in alert handler: {}", e.what());
+            LOG_RATE_LIMITED(spdlog::level::err, "Error in alert handler: {}", e.what());
         }
     }
 }
\ No newline at end of file
@@ -1,22 +1,45 @@
 #pragma once
 #include <unordered_map>
 #include <vector>
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
 #include <nlohmann/json.hpp>
+#include "MetricSchema.h"
+#include "Exemplars.h"
 
 struct Metric {
-    std::string endpoint;
-    std::string method;
-    uint64_t duration_ms;
-    std::string status;
-    uint64_t timestamp;
-    std::string trace_id;
-    std::string service_name;
-    std::string user_id;
-    std::string ip_address;
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string endpoint;
+    std::pmr::string method;
+    uint64_t duration_ms = 0;
+    std::pmr::string status;
+    StatusClass status_class = StatusClass::Unknown;
+    uint64_t timestamp = 0;
+    std::pmr::string trace_id;
+    std::pmr::string service_name;
+    std::pmr::string user_id;
+    std::pmr::string ip_address;
+
+    explicit Metric(const allocator_type& alloc = {})
+        : endpoint(alloc), method(alloc), status(alloc), trace_id(alloc),
+          service_name(alloc), user_id(alloc), ip_address(alloc) {}
+};
+
+struct EndpointKeyHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+        return std::hash<std::string_view>{}(key);
+    }
 };
 
 class CircularBuffer {
@@ -75,11 +98,16 @@ public:
     }
 };
 
+constexpr size_t kSlowestExemplarsPerEndpoint = 5;
+
 struct EndpointStats {
     std::unique_ptr<CircularBuffer> latency_buffer;
+    LatencyHistogram latency_histogram;
+    SlowestExemplars<kSlowestExemplarsPerEndpoint> slowest_exemplars;
     std::atomic<uint64_t> request_count{ 0 };
     std::atomic<uint64_t> error_count{ 0 };
     std::atomic<uint64_t> success_count{ 0 };
+    std::array<std::atomic<uint64_t>, kStatusClassCount> status_class_counts{};
     std::chrono::steady_clock::time_point last_request;
 
     EndpointStats() : latency_buffer(std::make_unique<CircularBuffer>(1000)) {
@@ -87,27 +115,77 @@ struct EndpointStats {
     }
 };
 
+// Actualiza los agregados de un endpoint según las agregaciones del esquema.
+// Devuelve si la métrica cuenta como error.
+template <typename Schema>
+bool aggregate_metric(EndpointStats& stats, const Metric& metric, uint64_t weight, int exemplar_window_seconds) {
+    bool is_error = is_error_status(metric.status_class);
+
+    if constexpr (schema_aggregates<Schema>(kAggregateCounts)) {
+        stats.request_count += weight;
+        stats.last_request = std::chrono::steady_clock::now();
+
+        if (!is_error) {
+            stats.success_count += weight;
+        }
+        else {
+            stats.error_count += weight;
+        }
+    }
+
+    if constexpr (schema_aggregates<Schema>(kAggregateStatusClasses)) {
+        stats.status_class_counts[static_cast<size_t>(metric.status_class)] += weight;
+    }
+
+    if constexpr (schema_aggregates<Schema>(kAggregateLatency)) {
+        stats.latency_buffer->push(static_cast<double>(metric.duration_ms));
+    }
+
+    if constexpr (schema_aggregates<Schema>(kAggregateExemplars)) {
+        std::string_view trace_id(metric.trace_id);
+        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        stats.latency_histogram.observe(metric.duration_ms, weight, trace_id, now_ms);
+
+        if (is_exemplar_trace_id(trace_id)) {
+            stats.slowest_exemplars.offer(trace_id, metric.duration_ms, now_ms,
+                exemplar_window(now_ms, exemplar_window_seconds));
+        }
+    }
+
+    return is_error;
+}
+
 class MetricsProcessor {
 private:
-    std::unordered_map<std::string, std::unique_ptr<EndpointStats>> endpoint_stats;
+    std::unordered_map<std::string, std::unique_ptr<EndpointStats>, EndpointKeyHash, std::equal_to<>> endpoint_stats;
     std::mutex stats_mutex;
 
     std::atomic<uint64_t> total_requests{ 0 };
     std::atomic<uint64_t> total_errors{ 0 };
+    std::atomic<uint64_t> total_shed{ 0 };
+    std::atomic<uint64_t> total_sampled_out{ 0 };
     std::chrono::steady_clock::time_point start_time;
 
     std::vector<std::function<void(const Metric&)>> alert_handlers;
 
 public:
     MetricsProcessor();
-    void process_metric(const Metric& metric);
+    void process_metric(const Metric& metric, uint64_t weight = 1);
     nlohmann::json get_realtime_metrics();
     nlohmann::json get_endpoint_metrics(const std::string& endpoint);
     nlohmann::json get_system_health();
+    std::string get_prometheus_metrics();
     bool is_anomaly(const Metric& metric);
     void add_alert_handler(std::function<void(const Metric&)> handler);
+    void record_shed();
+    void record_sampled_out();
 
 private:
-    std::string make_endpoint_key(const std::string& method, const std::string& endpoint);
-    void trigger_alerts(const Metric& metric);
+    std::pmr::string make_endpoint_key(const Metric& metric);
+    bool is_anomaly(const Metric& metric, const EndpointStats& stats);
+    nlohmann::json status_classes_json(const EndpointStats& stats) const;
+    nlohmann::json exemplars_json(const EndpointStats& stats) const;
+    void trigger_alerts(const Metric& metric, std::string_view key);
 };
\ No newline at end of file
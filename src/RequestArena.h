@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+// Arena monotónica por hilo de trabajo: todo lo que se reserva durante un
+// request sale del buffer inline y se libera de golpe al terminar el request.
+class RequestArena {
+private:
+    static constexpr size_t kInlineBytes = 16 * 1024;
+
+    alignas(std::max_align_t) std::array<std::byte, kInlineBytes> inline_buffer;
+    std::pmr::monotonic_buffer_resource resource;
+
+public:
+    RequestArena() : resource(inline_buffer.data(), inline_buffer.size()) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* get() {
+        return &resource;
+    }
+
+    void reset() {
+        resource.release();
+    }
+
+    static RequestArena& for_current_thread() {
+        thread_local RequestArena arena;
+        return arena;
+    }
+};
+
+class RequestArenaScope {
+private:
+    RequestArena& arena;
+
+public:
+    RequestArenaScope() : arena(RequestArena::for_current_thread()) {}
+    ~RequestArenaScope() { arena.reset(); }
+
+    RequestArenaScope(const RequestArenaScope&) = delete;
+    RequestArenaScope& operator=(const RequestArenaScope&) = delete;
+
+    std::pmr::memory_resource* resource() {
+        return arena.get();
+    }
+};
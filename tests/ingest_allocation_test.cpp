@@ -0,0 +1,114 @@
+// Verifica que la ruta de ingesta (parse_metric + process_metric) no reserva
+// memoria en el heap una vez calentada: endpoints ya creados y arena por hilo
+// ya inicializada.
+#include "Config.h"
+#include "MetricParser.h"
+#include "MetricsProcessor.h"
+#include "RequestArena.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+Config g_config;
+
+namespace {
+
+std::atomic<size_t> g_allocations{ 0 };
+
+void* counted_alloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* counted_aligned_alloc(size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    auto align = static_cast<size_t>(alignment);
+    size_t rounded = (size + align - 1) / align * align;
+    if (void* ptr = std::aligned_alloc(align, rounded ? rounded : align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+namespace {
+
+void ingest(MetricsProcessor& processor, const std::string& body) {
+    RequestArenaScope arena;
+    Metric metric(arena.resource());
+    parse_metric(body, metric);
+    processor.process_metric(metric);
+}
+
+}
+
+int main() {
+    const std::vector<std::string> bodies = {
+        R"({"endpoint":"/api/v1/users/profile/settings","method":"GET","duration":123,"status":"200","timestamp":1700000000,"trace_id":"4bf92f3577b34da6a3ce929d0e0e4736","service_name":"user-service-production","user_id":"user-0000001234","ip_address":"192.168.100.200"})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":48,"status":201,"timestamp":1700000001,"trace_id":"00f067aa0ba902b700f067aa0ba902b7","service_name":"orders"})",
+        R"({"endpoint":"/api/v1/orders","method":"GET","duration":2.5e2,"status":"success","timestamp":1700000002,"extra":{"tags":["a","b"],"retry":false}})",
+        R"({"endpoint":"/api/v1/checkout\/confirm","method":"PUT","duration":900,"status":"304","timestamp":1700000003,"user_id":"café"})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":75,"status":"500","timestamp":1700000004})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":31,"status":"201","timestamp":1700000005})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":29,"status":"201","timestamp":1700000006})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":40,"status":"201","timestamp":1700000007})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":33,"status":"201","timestamp":1700000008})",
+        R"({"endpoint":"/api/v1/orders","method":"POST","duration":35,"status":"201","timestamp":1700000009})"
+    };
+
+    MetricsProcessor processor;
+
+    constexpr int kWarmupRounds = 100;
+    constexpr int kMeasuredRounds = 10000;
+
+    for (int round = 0; round < kWarmupRounds; ++round) {
+        for (const auto& body : bodies) {
+            ingest(processor, body);
+        }
+    }
+
+    g_allocations.store(0);
+    for (int round = 0; round < kMeasuredRounds; ++round) {
+        for (const auto& body : bodies) {
+            ingest(processor, body);
+        }
+    }
+    size_t allocations = g_allocations.load();
+
+    auto metrics = processor.get_endpoint_metrics("POST:/api/v1/orders");
+    uint64_t expected = static_cast<uint64_t>(kWarmupRounds + kMeasuredRounds) * 7;
+    if (metrics["request_count"] != expected) {
+        std::fprintf(stderr, "FAIL: expected %llu POST:/api/v1/orders requests, got %s\n",
+            static_cast<unsigned long long>(expected), metrics["request_count"].dump().c_str());
+        return 1;
+    }
+
+    if (allocations != 0) {
+        std::fprintf(stderr, "FAIL: %zu heap allocations over %zu ingested metrics\n",
+            allocations, bodies.size() * kMeasuredRounds);
+        return 1;
+    }
+
+    std::printf("PASS: 0 heap allocations over %zu ingested metrics\n", bodies.size() * kMeasuredRounds);
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Casos de aceptación y rechazo del escáner de POST /metrics (parse_metric)
+#include "Config.h"
+#include "MetricParser.h"
+#include "MetricsProcessor.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+Config g_config;
+
+namespace {
+
+int g_failures = 0;
+
+void report_failure(std::string_view name, const std::string& detail) {
+    ++g_failures;
+    std::fprintf(stderr, "FAIL: %.*s: %s\n", static_cast<int>(name.size()), name.data(), detail.c_str());
+}
+
+// Payload válido con los campos requeridos; `extra` se añade al final, así
+// que sus claves sustituyen a las anteriores (la última gana)
+std::string payload(std::string_view extra = {}) {
+    std::string body = R"({"endpoint":"/a","method":"GET","duration":10,"status":"200","timestamp":1)";
+    if (!extra.empty()) {
+        body += ",";
+        body += extra;
+    }
+    body += "}";
+    return body;
+}
+
+bool parse(std::string_view name, const std::string& body, Metric& metric) {
+    try {
+        parse_metric(body, metric);
+        return true;
+    }
+    catch (const std::exception& e) {
+        report_failure(name, std::string("unexpected rejection: ") + e.what());
+        return false;
+    }
+}
+
+void expect_rejected(std::string_view name, const std::string& body, std::string_view message) {
+    Metric metric;
+    try {
+        parse_metric(body, metric);
+        report_failure(name, "payload was accepted");
+    }
+    catch (const std::invalid_argument& e) {
+        if (std::string_view(e.what()).find(message) == std::string_view::npos) {
+            report_failure(name, "expected \"" + std::string(message) + "\", got \"" + e.what() + "\"");
+        }
+    }
+}
+
+template <typename T>
+void expect_equal(std::string_view name, const T& actual, const T& expected) {
+    if (!(actual == expected)) {
+        report_failure(name, "value mismatch");
+    }
+}
+
+void test_invalid_utf8() {
+    constexpr std::string_view invalid = "invalid UTF-8 byte";
+
+    expect_rejected("utf8 invalid byte 0xff", payload("\"endpoint\":\"/a\xff\""), invalid);
+    expect_rejected("utf8 stray continuation", payload("\"endpoint\":\"/a\x80\""), invalid);
+    expect_rejected("utf8 overlong 2 bytes", payload("\"endpoint\":\"\xc0\xaf\""), invalid);
+    expect_rejected("utf8 overlong 3 bytes", payload("\"endpoint\":\"\xe0\x80\xaf\""), invalid);
+    expect_rejected("utf8 overlong 4 bytes", payload("\"endpoint\":\"\xf0\x80\x80\xaf\""), invalid);
+    expect_rejected("utf8 encoded surrogate", payload("\"endpoint\":\"\xed\xa0\x80\""), invalid);
+    expect_rejected("utf8 above U+10FFFF", payload("\"endpoint\":\"\xf4\x90\x80\x80\""), invalid);
+    expect_rejected("utf8 truncated sequence", payload("\"endpoint\":\"\xc3\""), invalid);
+    expect_rejected("utf8 truncated at end", "{\"endpoint\":\"\xe2\x82", invalid);
+    expect_rejected("utf8 in skipped value", payload("\"extra\":[\"\xff\"]"), invalid);
+    expect_rejected("utf8 in unknown key", payload("\"\xff\":1"), invalid);
+
+    Metric metric;
+    if (parse("utf8 valid multibyte", payload("\"endpoint\":\"/caf\xc3\xa9/\xe2\x82\xac/\xf0\x9f\x98\x80\""), metric)) {
+        expect_equal("utf8 valid multibyte", std::string_view(metric.endpoint),
+            std::string_view("/caf\xc3\xa9/\xe2\x82\xac/\xf0\x9f\x98\x80"));
+    }
+}
+
+void test_escapes() {
+    Metric metric;
+    if (parse("escapes decoded", payload(R"("endpoint":"\/a\\b\"c\n\té😀")"), metric)) {
+        expect_equal("escapes decoded", std::string_view(metric.endpoint),
+            std::string_view("/a\\b\"c\n\t\xc3\xa9\xf0\x9f\x98\x80"));
+    }
+
+    expect_rejected("bad escape letter", payload(R"("endpoint":"\x41")"), "invalid escape sequence");
+    expect_rejected("bad unicode hex", payload(R"("endpoint":"\u12G4")"), "invalid unicode escape");
+    expect_rejected("short unicode escape", payload(R"("endpoint":"\u12")"), "invalid unicode escape");
+    expect_rejected("raw control character", payload("\"endpoint\":\"a\tb\""), "control character in string");
+    expect_rejected("unterminated string", R"({"endpoint":"/a)", "unterminated string");
+}
+
+void test_surrogates() {
+    expect_rejected("lone high surrogate", payload(R"("endpoint":"\ud800")"), "unpaired high surrogate");
+    expect_rejected("high surrogate then char", payload(R"("endpoint":"\ud800a")"), "unpaired high surrogate");
+    expect_rejected("high surrogate then non-low", payload(R"("endpoint":"\ud800\u0041")"), "invalid low surrogate");
+    expect_rejected("lone low surrogate", payload(R"("endpoint":"\udc00")"), "unpaired low surrogate");
+}
+
+void test_durations() {
+    constexpr std::string_view invalid = "Invalid type for field: duration";
+
+    expect_rejected("duration 1e30", payload(R"("duration":1e30)"), invalid);
+    expect_rejected("duration negative", payload(R"("duration":-5)"), invalid);
+    expect_rejected("duration negative zero", payload(R"("duration":-0)"), invalid);
+    expect_rejected("duration negative float", payload(R"("duration":-0.5)"), invalid);
+    expect_rejected("duration above uint64", payload(R"("duration":18446744073709551616)"), invalid);
+    expect_rejected("duration float at 2^64", payload(R"("duration":1.8446744073709552e19)"), invalid);
+    expect_rejected("duration string", payload(R"("duration":"10")"), invalid);
+    expect_rejected("duration leading zeros", payload(R"("duration":010)"), "expected ',' or '}'");
+    expect_rejected("duration missing exponent", payload(R"("duration":1e)"), "invalid number");
+    expect_rejected("duration missing fraction", payload(R"("duration":1.)"), "invalid number");
+
+    Metric metric;
+    if (parse("duration exponent", payload(R"("duration":2.5e2)"), metric)) {
+        expect_equal("duration exponent", metric.duration_ms, uint64_t{ 250 });
+    }
+    if (parse("duration fraction truncated", payload(R"("duration":12.9)"), metric)) {
+        expect_equal("duration fraction truncated", metric.duration_ms, uint64_t{ 12 });
+    }
+    if (parse("duration zero", payload(R"("duration":0)"), metric)) {
+        expect_equal("duration zero", metric.duration_ms, uint64_t{ 0 });
+    }
+    if (parse("duration uint64 max", payload(R"("duration":18446744073709551615)"), metric)) {
+        expect_equal("duration uint64 max", metric.duration_ms, UINT64_MAX);
+    }
+}
+
+void test_document_structure() {
+    expect_rejected("trailing garbage", payload() + " x", "unexpected characters after the JSON object");
+    expect_rejected("second object", payload() + "{}", "unexpected characters after the JSON object");
+    expect_rejected("not an object", "[]", "Metric payload must be a JSON object");
+    expect_rejected("empty body", "", "Metric payload must be a JSON object");
+    expect_rejected("missing comma", R"({"endpoint":"/a" "method":"GET"})", "expected ',' or '}'");
+    expect_rejected("bad literal", payload(R"("extra":tru)"), "invalid literal");
+
+    auto nested = [](size_t depth) {
+        return "\"extra\":" + std::string(depth, '[') + std::string(depth, ']');
+    };
+    Metric metric;
+    parse("nesting at limit", payload(nested(64)), metric);
+    expect_rejected("nesting too deep", payload(nested(65)), "nesting too deep");
+}
+
+void test_required_fields() {
+    expect_rejected("missing endpoint", R"({"method":"GET","duration":1,"status":"200","timestamp":1})",
+        "Missing required field: endpoint");
+    expect_rejected("missing method", R"({"endpoint":"/a","duration":1,"status":"200","timestamp":1})",
+        "Missing required field: method");
+    expect_rejected("missing duration", R"({"endpoint":"/a","method":"GET","status":"200","timestamp":1})",
+        "Missing required field: duration");
+    expect_rejected("missing status", R"({"endpoint":"/a","method":"GET","duration":1,"timestamp":1})",
+        "Missing required field: status");
+    expect_rejected("missing timestamp", R"({"endpoint":"/a","method":"GET","duration":1,"status":"200"})",
+        "Missing required field: timestamp");
+    expect_rejected("wrong string type", payload(R"("endpoint":5)"), "Invalid type for field: endpoint");
+    expect_rejected("null optional field", payload(R"("trace_id":null)"), "Invalid type for field: trace_id");
+
+    Metric metric;
+    if (parse("service_name default", payload(), metric)) {
+        expect_equal("service_name default", std::string_view(metric.service_name), std::string_view("unknown"));
+    }
+}
+
+void test_duplicate_keys() {
+    Metric metric;
+    if (parse("duplicate keys", payload(R"("endpoint":"/b","duration":20,"endpoint":"/c")"), metric)) {
+        expect_equal("duplicate string key keeps last", std::string_view(metric.endpoint), std::string_view("/c"));
+        expect_equal("duplicate number key keeps last", metric.duration_ms, uint64_t{ 20 });
+    }
+}
+
+void test_status() {
+    struct Case {
+        const char* member;
+        std::string_view status;
+        StatusClass status_class;
+    };
+    const Case cases[] = {
+        { R"("status":"200")", "200", StatusClass::Success },
+        { R"("status":200)", "200", StatusClass::Success },
+        { R"("status":404)", "404", StatusClass::ClientError },
+        { R"("status":"503")", "503", StatusClass::ServerError },
+        { R"("status":"success")", "success", StatusClass::Success },
+        { R"("status":"ok")", "ok", StatusClass::Unknown },
+        { R"("status":"302")", "302", StatusClass::Redirect },
+        { R"("status":"error")", "error", StatusClass::Unknown },
+        { R"("status":42)", "42", StatusClass::Unknown }
+    };
+
+    for (const auto& c : cases) {
+        Metric metric;
+        if (parse(c.member, payload(c.member), metric)) {
+            expect_equal(c.member, std::string_view(metric.status), c.status);
+            expect_equal(c.member, metric.status_class, c.status_class);
+        }
+    }
+
+    expect_rejected("status boolean", payload(R"("status":true)"), "Invalid type for field: status");
+    expect_rejected("status negative", payload(R"("status":-200)"), "Invalid type for field: status");
+}
+
+}
+
+int main() {
+    test_invalid_utf8();
+    test_escapes();
+    test_surrogates();
+    test_durations();
+    test_document_structure();
+    test_required_fields();
+    test_duplicate_keys();
+    test_status();
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d metric parser checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("PASS: metric parser\n");
+    return 0;
+}